@@ -52,7 +52,9 @@
 #include <vector>
 #include <algorithm>
 #include <omp.h> // OpenMP for parallel processing
-#include <random>
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
 
 using namespace std;
 
@@ -88,8 +90,139 @@ GlobalSetup(
 		STAGE_VERSION,
 		BUILD_VERSION);
 
-	out_data->out_flags = PF_OutFlag_DEEP_COLOR_AWARE;	// just 16bpc, not 32bpc
+	out_data->out_flags = PF_OutFlag_DEEP_COLOR_AWARE |	// just 16bpc, not 32bpc
+		PF_OutFlag_NON_PARAM_VARY |						// worst case; narrowed by QueryDynamicFlags
+		PF_OutFlag_SEQUENCE_DATA_NEEDS_FLATTENING;			// threshold map cache holds a handle
 
+	out_data->out_flags2 = PF_OutFlag2_SUPPORTS_QUERY_DYNAMIC_FLAGS;
+
+	return PF_Err_NONE;
+}
+
+static PF_Err
+QueryDynamicFlags(
+	PF_InData* in_data,
+	PF_OutData* out_data,
+	PF_ParamDef* params[],
+	void* extra)
+{
+	// Only animated White Noise changes on a still; every other setting
+	// lets AE reuse frames for stills and solids
+	if (params[PUNKDITHER_ALGORITHM]->u.pd.value == 4 && params[PUNKDITHER_NOISE_ANIMATE]->u.bd.value) {
+		out_data->out_flags |= PF_OutFlag_NON_PARAM_VARY;
+	}
+	else {
+		out_data->out_flags &= ~PF_OutFlag_NON_PARAM_VARY;
+	}
+
+	return PF_Err_NONE;
+}
+
+static PF_Err
+SequenceSetup(
+	PF_InData* in_data,
+	PF_OutData* out_data,
+	PF_ParamDef* params[],
+	PF_LayerDef* output)
+{
+	AEGP_SuiteHandler suites(in_data->pica_basicP);
+
+	PF_Handle seqH = suites.HandleSuite1()->host_new_handle(sizeof(PunkDitherSequenceData));
+	if (!seqH) {
+		return PF_Err_OUT_OF_MEMORY;
+	}
+
+	PunkDitherSequenceData* seqP = reinterpret_cast<PunkDitherSequenceData*>(suites.HandleSuite1()->host_lock_handle(seqH));
+	AEFX_CLR_STRUCT(*seqP);
+	suites.HandleSuite1()->host_unlock_handle(seqH);
+
+	out_data->sequence_data = seqH;
+	return PF_Err_NONE;
+}
+
+static PF_Err
+SequenceResetup(
+	PF_InData* in_data,
+	PF_OutData* out_data,
+	PF_ParamDef* params[],
+	PF_LayerDef* output)
+{
+	if (!in_data->sequence_data) {
+		return SequenceSetup(in_data, out_data, params, output);
+	}
+
+	AEGP_SuiteHandler suites(in_data->pica_basicP);
+
+	// Flattened data never carries a live cache handle; start the cache empty.
+	PunkDitherSequenceData* seqP = reinterpret_cast<PunkDitherSequenceData*>(suites.HandleSuite1()->host_lock_handle(in_data->sequence_data));
+	seqP->mapValid = FALSE;
+	seqP->mapH = NULL;
+	seqP->projectionValid = FALSE;
+	seqP->projectionH = NULL;
+	seqP->governorTier = GOVERNOR_TIER_FULL;
+	seqP->governorSamples = 0;
+	seqP->governorNext = 0;
+	suites.HandleSuite1()->host_unlock_handle(in_data->sequence_data);
+
+	out_data->sequence_data = in_data->sequence_data;
+	return PF_Err_NONE;
+}
+
+static PF_Err
+SequenceFlatten(
+	PF_InData* in_data,
+	PF_OutData* out_data,
+	PF_ParamDef* params[],
+	PF_LayerDef* output)
+{
+	if (!in_data->sequence_data) {
+		return PF_Err_NONE;
+	}
+
+	AEGP_SuiteHandler suites(in_data->pica_basicP);
+
+	// The cached map and cube are cheap to rebuild, so flattening just drops them.
+	PunkDitherSequenceData* seqP = reinterpret_cast<PunkDitherSequenceData*>(suites.HandleSuite1()->host_lock_handle(in_data->sequence_data));
+	if (seqP->mapH) {
+		suites.HandleSuite1()->host_dispose_handle(seqP->mapH);
+	}
+	if (seqP->projectionH) {
+		suites.HandleSuite1()->host_dispose_handle(seqP->projectionH);
+	}
+	seqP->mapValid = FALSE;
+	seqP->mapH = NULL;
+	seqP->projectionValid = FALSE;
+	seqP->projectionH = NULL;
+	suites.HandleSuite1()->host_unlock_handle(in_data->sequence_data);
+
+	out_data->sequence_data = in_data->sequence_data;
+	return PF_Err_NONE;
+}
+
+static PF_Err
+SequenceSetdown(
+	PF_InData* in_data,
+	PF_OutData* out_data,
+	PF_ParamDef* params[],
+	PF_LayerDef* output)
+{
+	if (!in_data->sequence_data) {
+		return PF_Err_NONE;
+	}
+
+	AEGP_SuiteHandler suites(in_data->pica_basicP);
+
+	PunkDitherSequenceData* seqP = reinterpret_cast<PunkDitherSequenceData*>(suites.HandleSuite1()->host_lock_handle(in_data->sequence_data));
+	if (seqP->mapH) {
+		suites.HandleSuite1()->host_dispose_handle(seqP->mapH);
+	}
+	if (seqP->projectionH) {
+		suites.HandleSuite1()->host_dispose_handle(seqP->projectionH);
+	}
+	suites.HandleSuite1()->host_unlock_handle(in_data->sequence_data);
+
+	suites.HandleSuite1()->host_dispose_handle(in_data->sequence_data);
+	out_data->sequence_data = NULL;
 	return PF_Err_NONE;
 }
 
@@ -153,9 +286,9 @@ ParamsSetup(
 	AEFX_CLR_STRUCT(def);
 	PF_ADD_POPUP(
 		"Dithering Algorithm",
-		3, // Number of choices
+		5, // Number of choices
 		1, // Default (1 = Error Diffusion)
-		"Error Diffusion|Bayer Matrix|Blue Noise", // Labels
+		"Error Diffusion|Bayer Matrix|Blue Noise|White Noise|Threshold Map", // Labels
 		6  // Param ID
 	);
 
@@ -168,8 +301,91 @@ ParamsSetup(
 		7  // Param ID
 	);
 
+	// 🔪 Pre-sharpen (Unsharp Mask before thresholding, 0 = off)
+	AEFX_CLR_STRUCT(def);
+	PF_ADD_FLOAT_SLIDERX(
+		"Sharpen Amount",
+		0.0, 4.0, 0.0, 2.0, 0.0,  // Min, Max, Default
+		PF_Precision_HUNDREDTHS, 0, 0,
+		8  // Param ID
+	);
+
+	AEFX_CLR_STRUCT(def);
+	PF_ADD_SLIDER(
+		"Sharpen Radius",
+		1, 64, 1, 16, 2,  // Min, Max, Slider Min, Slider Max, Default
+		9  // Param ID
+	);
+
+	// 🎲 White Noise (counter-based, identical on every render node)
+	AEFX_CLR_STRUCT(def);
+	PF_ADD_SLIDER(
+		"Noise Seed",
+		0, 100000, 0, 1000, 0,  // Min, Max, Slider Min, Slider Max, Default
+		10  // Param ID
+	);
+
+	AEFX_CLR_STRUCT(def);
+	PF_ADD_CHECKBOX(
+		"Animate Noise",
+		"Per Frame",
+		FALSE, 0,
+		11  // Param ID
+	);
+
+	// 🗺 Threshold Map (any layer, tiled at native size; Bayer if none)
+	AEFX_CLR_STRUCT(def);
+	PF_ADD_LAYER(
+		"Threshold Map",
+		PF_LayerDefault_NONE,
+		12  // Param ID
+	);
 
-	out_data->num_params = 8;  // Updated to include the new dropdown
+	AEFX_CLR_STRUCT(def);
+	PF_ADD_FLOAT_SLIDERX(
+		"Map Scale",
+		0.0, 4.0, 0.0, 2.0, 1.0,  // Min, Max, Default
+		PF_Precision_HUNDREDTHS, 0, 0,
+		13  // Param ID
+	);
+
+	AEFX_CLR_STRUCT(def);
+	PF_ADD_FLOAT_SLIDERX(
+		"Map Offset",
+		-1.0, 1.0, -1.0, 1.0, 0.0,  // Min, Max, Default
+		PF_Precision_HUNDREDTHS, 0, 0,
+		14  // Param ID
+	);
+
+	// ⏱ Preview Governor (Draft or Half/Quarter previews only, never final renders)
+	AEFX_CLR_STRUCT(def);
+	PF_ADD_CHECKBOX(
+		"Preview Governor",
+		"Hold Frame Budget",
+		FALSE, 0,
+		15  // Param ID
+	);
+
+	AEFX_CLR_STRUCT(def);
+	PF_ADD_FLOAT_SLIDERX(
+		"Preview Budget (ms)",
+		1.0, 1000.0, 5.0, 100.0, 33.3,  // Min, Max, Default
+		PF_Precision_TENTHS, 0, 0,
+		16  // Param ID
+	);
+
+	// 🌈 How a pixel's level between Color A and Color B is measured
+	AEFX_CLR_STRUCT(def);
+	PF_ADD_POPUP(
+		"Two-Color Mode",
+		2, // Number of choices
+		1, // Default (1 = Luma)
+		"Luma|Perceptual (OKLab)", // Labels
+		17  // Param ID
+	);
+
+
+	out_data->num_params = PUNKDITHER_NUM_PARAMS;
 
 
 	return err;
@@ -232,243 +448,299 @@ MySimpleGainFunc8(
 }
 
 
-using namespace std;
-
-// Improved 8x8 Bayer matrix for smoother dithering
-const int bayerMatrix8x8[8][8] = {
-	{  0, 32,  8, 40,  2, 34, 10, 42 },
-	{ 48, 16, 56, 24, 50, 18, 58, 26 },
-	{ 12, 44,  4, 36, 14, 46,  6, 38 },
-	{ 60, 28, 52, 20, 62, 30, 54, 22 },
-	{  3, 35, 11, 43,  1, 33,  9, 41 },
-	{ 51, 19, 59, 27, 49, 17, 57, 25 },
-	{ 15, 47,  7, 39, 13, 45,  5, 37 },
-	{ 63, 31, 55, 23, 61, 29, 53, 21 }
-};
-
-void ApplyBayerDither(PF_LayerDef* output, PunkDitherParams* params) {
-	int width = output->extent_hint.right;
-	int height = output->extent_hint.bottom;
-	int rowbytes = output->rowbytes;
-
-	float strength = params->strength * 4.0f; // Adjust dither intensity based on slider
-
-#pragma omp parallel for schedule(dynamic)
-	for (int y = 0; y < height; y++) {
-		PF_Pixel8* row = (PF_Pixel8*)((char*)output->data + y * rowbytes);
-		for (int x = 0; x < width; x++) {
-			PF_Pixel8* pixel = &row[x];
-			int threshold = bayerMatrix8x8[y % 8][x % 8] * strength; // Adjust with slider strength
-			int grayscale = (pixel->red + pixel->green + pixel->blue) / 3;
-			bool ditherMask = grayscale > threshold;
-			pixel->red = ditherMask ? params->colorB.red : params->colorA.red;
-			pixel->green = ditherMask ? params->colorB.green : params->colorA.green;
-			pixel->blue = ditherMask ? params->colorB.blue : params->colorA.blue;
-		}
+void RetroDitherDownscale(PF_LayerDef* input, PF_LayerDef* output, int downscaleFactor) {
+	if (downscaleFactor <= 1) {
+		return;  // No downscaling needed
 	}
-}
 
+	int width = input->width;
+	int height = input->height;
+	int downWidth = width / downscaleFactor;
+	int downHeight = height / downscaleFactor;
 
-void ApplyBlueNoiseDither(PF_LayerDef* output, PunkDitherParams* params) {
-	int width = output->extent_hint.right - output->extent_hint.left;
-	int height = output->extent_hint.bottom - output->extent_hint.top;
-	int rowbytes = output->rowbytes;
-	std::vector<int> noise(width * height);
+	std::vector<PF_Pixel8> downsampled(downWidth * downHeight);
 
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_int_distribution<int> dis(0, 255);
+	// Step 1: Downscale - Sample nearest pixel without averaging
+	for (int y = 0; y < downHeight; y++) {
+		for (int x = 0; x < downWidth; x++) {
+			int srcX = x * downscaleFactor;
+			int srcY = y * downscaleFactor;
 
-	for (int i = 0; i < width * height; i++) {
-		noise[i] = dis(gen);
+			PF_Pixel8* srcPixel = (PF_Pixel8*)((char*)input->data + srcY * input->rowbytes) + srcX;
+			downsampled[y * downWidth + x] = *srcPixel;
+		}
 	}
 
+	// Step 2: Upscale - Restore to original size using nearest-neighbor
 	for (int y = 0; y < height; y++) {
-		PF_Pixel8* row = (PF_Pixel8*)((char*)output->data + y * rowbytes);
 		for (int x = 0; x < width; x++) {
-			PF_Pixel8* pixel = &row[x];
-			int grayscale = (pixel->red + pixel->green + pixel->blue) / 3;
-			int threshold = noise[y * width + x] * params->strength;
-			bool ditherMask = grayscale > threshold;
-			pixel->red = ditherMask ? params->colorB.red : params->colorA.red;
-			pixel->green = ditherMask ? params->colorB.green : params->colorA.green;
-			pixel->blue = ditherMask ? params->colorB.blue : params->colorA.blue;
+			int srcX = x / downscaleFactor;
+			int srcY = y / downscaleFactor;
+
+			PF_Pixel8* dstPixel = (PF_Pixel8*)((char*)output->data + y * output->rowbytes) + x;
+			*dstPixel = downsampled[srcY * downWidth + srcX];
 		}
 	}
 }
 
 
+// Order-sensitive 64-bit fingerprint of a layer's visible pixels, used to
+// tell whether the cached threshold map still matches the checked-out frame.
+static A_u_longlong FingerprintWorld(const PF_LayerDef* world) {
+	int width = world->width;
+	int height = world->height;
+	size_t pixelBytes = PF_WORLD_IS_DEEP(world) ? sizeof(PF_Pixel16) : sizeof(PF_Pixel8);
+	size_t rowLength = width * pixelBytes;
+	A_u_longlong hash = 0;
 
+#pragma omp parallel for schedule(static) reduction(^:hash)
+	for (int y = 0; y < height; y++) {
+		const A_u_char* src = (const A_u_char*)world->data + (size_t)y * world->rowbytes;
+		A_u_longlong h = 0xcbf29ce484222325ULL ^ (A_u_longlong)y;
+		size_t i = 0;
+		for (; i + 8 <= rowLength; i += 8) {
+			A_u_longlong word;
+			memcpy(&word, src + i, 8);
+			h = (h ^ word) * 0x100000001b3ULL;
+			h ^= h >> 29;
+		}
+		for (; i < rowLength; i++) {
+			h = (h ^ src[i]) * 0x100000001b3ULL;
+		}
+		hash ^= h * 0x9E3779B97F4A7C15ULL + (A_u_longlong)y;
+	}
 
+	return hash ^ ((A_u_longlong)width << 32) ^ (A_u_longlong)height ^ (A_u_longlong)pixelBytes << 60;
+}
 
-#include <cstdlib>  // For randomness
-
-void ApplyPunkDither(PF_LayerDef* output, PunkDitherParams* params, int direction) {
-	if (params->strength < 0.01) return;
-
-	int width = output->extent_hint.right;
-	int height = output->extent_hint.bottom;
-	int rowbytes = output->rowbytes;
-	PF_FpLong strength = MAX(0.05, params->strength);
-
+// Converts the map layer to an 8-bit luma tile with level scale and offset
+// applied, reusing the copy in sequence data when the frame and levels match.
+static PF_Err
+PrepareThresholdMap(
+	PF_InData* in_data,
+	PunkDitherSequenceData* seqP,
+	const PF_LayerDef* mapWorld,
+	PF_FpLong mapScale,
+	PF_FpLong mapOffset,
+	const A_u_char** tilePP)
+{
+	AEGP_SuiteHandler suites(in_data->pica_basicP);
 
+	int width = mapWorld->width;
+	int height = mapWorld->height;
+	A_u_longlong sourceHash = FingerprintWorld(mapWorld);
 
-	if (direction == 1) {  // 🔼 UP - Process bottom to top (Unmodified)
-		for (int y = height - 1; y > 0; y--) {
-			PF_Pixel8* row = (PF_Pixel8*)((char*)output->data + y * rowbytes);
-			PF_Pixel8* rowAbove = (PF_Pixel8*)((char*)output->data + (y - 1) * rowbytes);
+	*tilePP = NULL;
 
-			for (int x = 1; x < width - 1; x++) {
-				PF_Pixel8* pixel = &row[x];
-				int grayscale = (pixel->red + pixel->green + pixel->blue) / 3;
-				int threshold = 128 * (1.0 - strength);
-				threshold = MAX(64, MIN(192, threshold));
-				bool ditherMask = (grayscale > threshold);
-				int ditherValue = ditherMask ? 255 : 0;
-				int err = grayscale - ditherValue;
-				int diffusionFactor = 8 + (8 * strength);
+	if (!seqP->mapValid ||
+		seqP->mapSourceHash != sourceHash ||
+		seqP->mapScale != mapScale ||
+		seqP->mapOffset != mapOffset ||
+		seqP->mapWidth != width ||
+		seqP->mapHeight != height) {
 
-				if (y > 0) {
-					rowAbove[x].red = MIN(255, MAX(0, rowAbove[x].red + err * 8 / diffusionFactor));
-					rowAbove[x].green = MIN(255, MAX(0, rowAbove[x].green + err * 8 / diffusionFactor));
-					rowAbove[x].blue = MIN(255, MAX(0, rowAbove[x].blue + err * 8 / diffusionFactor));
-				}
-				pixel->red = ditherMask ? params->colorB.red : params->colorA.red;
-				pixel->green = ditherMask ? params->colorB.green : params->colorA.green;
-				pixel->blue = ditherMask ? params->colorB.blue : params->colorA.blue;
-			}
-		}
-	}
-	else if (direction == 2) {  // 🔽 DOWN - Process top to bottom
-		for (int y = 0; y < height - 1; y++) {
-			PF_Pixel8* row = (PF_Pixel8*)((char*)output->data + y * rowbytes);
-			PF_Pixel8* rowBelow = (PF_Pixel8*)((char*)output->data + (y + 1) * rowbytes);
-
-			for (int x = 1; x < width - 1; x++) {
-				PF_Pixel8* pixel = &row[x];
-				int grayscale = (pixel->red + pixel->green + pixel->blue) / 3;
-				int threshold = 128 * (1.0 - strength);
-				threshold = MAX(64, MIN(192, threshold));
-				bool ditherMask = (grayscale > threshold);
-				int ditherValue = ditherMask ? 255 : 0;
-				int err = grayscale - ditherValue;
-				int diffusionFactor = 8 + (8 * strength);
-
-				if (y < height - 1) {
-					rowBelow[x].red = MIN(255, MAX(0, rowBelow[x].red + err * 8 / diffusionFactor));
-					rowBelow[x].green = MIN(255, MAX(0, rowBelow[x].green + err * 8 / diffusionFactor));
-					rowBelow[x].blue = MIN(255, MAX(0, rowBelow[x].blue + err * 8 / diffusionFactor));
-				}
-				pixel->red = ditherMask ? params->colorB.red : params->colorA.red;
-				pixel->green = ditherMask ? params->colorB.green : params->colorA.green;
-				pixel->blue = ditherMask ? params->colorB.blue : params->colorA.blue;
-			}
+		seqP->mapValid = FALSE;
+		if (seqP->mapH && (seqP->mapWidth != width || seqP->mapHeight != height)) {
+			suites.HandleSuite1()->host_dispose_handle(seqP->mapH);
+			seqP->mapH = NULL;
 		}
-	}
-	else if (direction == 3) {  // ◀ LEFT - FIXED (Prevents dithering issues with white)
-		if (strength > 0.01) {
-			for (int y = 0; y < height; y++) {
-				PF_Pixel8* row = (PF_Pixel8*)((char*)output->data + y * rowbytes);
-
-				for (int x = width - 1; x > 0; x--) {
-					PF_Pixel8* pixel = &row[x];
-					int grayscale = (pixel->red + pixel->green + pixel->blue) / 3;
-					int threshold = 128 * (1.0 - strength);
-					threshold = MAX(64, MIN(192, threshold));
-					bool ditherMask = (grayscale > threshold);
-					int ditherValue = ditherMask ? 255 : 0;
-					int err = grayscale - ditherValue;
-					int diffusionFactor = 8 + (8 * strength);
-
-					if (x > 0) {
-						row[x - 1].red = MIN(255, MAX(0, row[x - 1].red + err * 8 / diffusionFactor));
-						row[x - 1].green = MIN(255, MAX(0, row[x - 1].green + err * 8 / diffusionFactor));
-						row[x - 1].blue = MIN(255, MAX(0, row[x - 1].blue + err * 8 / diffusionFactor));
-					}
-
-					// 🛠 FIX: Properly handle bright pixels (Prevent unwanted dithering on white)
-					if (pixel->red > 240 && pixel->green > 240 && pixel->blue > 240) {
-						pixel->red = params->colorB.red;
-						pixel->green = params->colorB.green;
-						pixel->blue = params->colorB.blue;
-					}
-					else {
-						pixel->red = ditherMask ? params->colorB.red : params->colorA.red;
-						pixel->green = ditherMask ? params->colorB.green : params->colorA.green;
-						pixel->blue = ditherMask ? params->colorB.blue : params->colorA.blue;
-					}
-				}
+		if (!seqP->mapH) {
+			seqP->mapH = suites.HandleSuite1()->host_new_handle((A_u_long)width * height);
+			if (!seqP->mapH) {
+				return PF_Err_OUT_OF_MEMORY;
 			}
 		}
-	}
-	else if (direction == 4) {  // ▶ RIGHT - Unchanged
+
+		A_u_char* tile = reinterpret_cast<A_u_char*>(suites.HandleSuite1()->host_lock_handle(seqP->mapH));
+		bool deep = PF_WORLD_IS_DEEP(mapWorld);
+		float scale = (float)mapScale;
+		float offset = (float)mapOffset * 255.0f;
+
+#pragma omp parallel for schedule(static)
 		for (int y = 0; y < height; y++) {
-			PF_Pixel8* row = (PF_Pixel8*)((char*)output->data + y * rowbytes);
-
-			for (int x = 0; x < width - 1; x++) {
-				PF_Pixel8* pixel = &row[x];
-				int grayscale = (pixel->red + pixel->green + pixel->blue) / 3;
-				int threshold = 128 * (1.0 - strength);
-				threshold = MAX(64, MIN(192, threshold));
-				bool ditherMask = (grayscale > threshold);
-				int ditherValue = ditherMask ? 255 : 0;
-				int err = grayscale - ditherValue;
-				int diffusionFactor = 8 + (8 * strength);
-
-				if (x < width - 1) {
-					row[x + 1].red = MIN(255, MAX(0, row[x + 1].red + err * 8 / diffusionFactor));
-					row[x + 1].green = MIN(255, MAX(0, row[x + 1].green + err * 8 / diffusionFactor));
-					row[x + 1].blue = MIN(255, MAX(0, row[x + 1].blue + err * 8 / diffusionFactor));
+			const char* src = (const char*)mapWorld->data + (size_t)y * mapWorld->rowbytes;
+			A_u_char* dst = tile + (size_t)y * width;
+			for (int x = 0; x < width; x++) {
+				int luma;
+				if (deep) {
+					const PF_Pixel16* p = (const PF_Pixel16*)src + x;
+					luma = ((p->red + p->green + p->blue) / 3) * PF_MAX_CHAN8 / PF_MAX_CHAN16;
+				}
+				else {
+					const PF_Pixel8* p = (const PF_Pixel8*)src + x;
+					luma = (p->red + p->green + p->blue) / 3;
 				}
-				pixel->red = ditherMask ? params->colorB.red : params->colorA.red;
-				pixel->green = ditherMask ? params->colorB.green : params->colorA.green;
-				pixel->blue = ditherMask ? params->colorB.blue : params->colorA.blue;
+				int level = (int)(luma * scale + offset);
+				dst[x] = (A_u_char)MIN(255, MAX(0, level));
 			}
 		}
+
+		suites.HandleSuite1()->host_unlock_handle(seqP->mapH);
+
+		seqP->mapSourceHash = sourceHash;
+		seqP->mapScale = mapScale;
+		seqP->mapOffset = mapOffset;
+		seqP->mapWidth = width;
+		seqP->mapHeight = height;
+		seqP->mapValid = TRUE;
 	}
 
+	*tilePP = reinterpret_cast<const A_u_char*>(suites.HandleSuite1()->host_lock_handle(seqP->mapH));
+	return PF_Err_NONE;
+}
 
+static inline PunkPixel8 ToPunkPixel(const PF_Pixel8& color) {
+	PunkPixel8 pixel;
+	pixel.alpha = color.alpha;
+	pixel.red = color.red;
+	pixel.green = color.green;
+	pixel.blue = color.blue;
+	return pixel;
 }
 
-void RetroDitherDownscale(PF_LayerDef* input, PF_LayerDef* output, int downscaleFactor) {
-	if (downscaleFactor <= 1) {
-		return;  // No downscaling needed
-	}
+// Radii are given in full-resolution pixels; at Half/Quarter preview
+// resolution the buffer is smaller, so the radius must shrink with it.
+static inline int ScaleRadius(A_long radius, const PF_RationalScale& scale) {
+	if (scale.den == 0) return radius;
+	return (int)((PF_FpLong)radius * scale.num / scale.den + 0.5);
+}
 
-	int width = input->width;
-	int height = input->height;
-	int downWidth = width / downscaleFactor;
-	int downHeight = height / downscaleFactor;
+static_assert(sizeof(PunkPixel8) == sizeof(PF_Pixel8), "kernels process PF_Pixel8 worlds in place");
 
-	std::vector<PF_Pixel8> downsampled(downWidth * downHeight);
+// Returns the colorA->colorB projection cube, rebaking it in sequence data
+// only when either color has changed since the last render.
+static PF_Err
+PrepareProjectionLUT(
+	PF_InData* in_data,
+	PunkDitherSequenceData* seqP,
+	const PF_Pixel8& colorA,
+	const PF_Pixel8& colorB,
+	const A_u_char** lutPP)
+{
+	AEGP_SuiteHandler suites(in_data->pica_basicP);
 
-	// Step 1: Downscale - Sample nearest pixel without averaging
-	for (int y = 0; y < downHeight; y++) {
-		for (int x = 0; x < downWidth; x++) {
-			int srcX = x * downscaleFactor;
-			int srcY = y * downscaleFactor;
+	*lutPP = NULL;
 
-			PF_Pixel8* srcPixel = (PF_Pixel8*)((char*)input->data + srcY * input->rowbytes) + srcX;
-			downsampled[y * downWidth + x] = *srcPixel;
+	if (!seqP->projectionH) {
+		seqP->projectionValid = FALSE;
+		seqP->projectionH = suites.HandleSuite1()->host_new_handle(PUNK_PROJECTION_LUT_SIZE);
+		if (!seqP->projectionH) {
+			return PF_Err_OUT_OF_MEMORY;
 		}
 	}
 
-	// Step 2: Upscale - Restore to original size using nearest-neighbor
-	for (int y = 0; y < height; y++) {
-		for (int x = 0; x < width; x++) {
-			int srcX = x / downscaleFactor;
-			int srcY = y / downscaleFactor;
+	A_u_char* lut = reinterpret_cast<A_u_char*>(suites.HandleSuite1()->host_lock_handle(seqP->projectionH));
 
-			PF_Pixel8* dstPixel = (PF_Pixel8*)((char*)output->data + y * output->rowbytes) + x;
-			*dstPixel = downsampled[srcY * downWidth + srcX];
+	if (!seqP->projectionValid ||
+		memcmp(&seqP->projectionA, &colorA, sizeof(PF_Pixel8)) != 0 ||
+		memcmp(&seqP->projectionB, &colorB, sizeof(PF_Pixel8)) != 0) {
+
+		BuildProjectionLUT(lut, ToPunkPixel(colorA), ToPunkPixel(colorB));
+		seqP->projectionA = colorA;
+		seqP->projectionB = colorB;
+		seqP->projectionValid = TRUE;
+	}
+
+	*lutPP = lut;
+	return PF_Err_NONE;
+}
+
+// True only when the render positively looks like an interactive preview:
+// Draft quality or a downsampled (Half/Quarter...) resolution, with the
+// render queue idle. Anything else, including Dynamic Link / AME renders at
+// full resolution, is treated as final and gets full quality.
+//
+// Caching caveat: AE caches frames by params, time, quality and resolution,
+// not by governor tier. Restricting the governor to Draft or downsampled
+// renders keeps degraded frames out of the cache entries that full-quality
+// renders use. A degraded Draft/Half frame can still stay in the RAM preview
+// cache at that setting until something invalidates it. Purge or nudge a
+// param to refresh it.
+static bool
+IsInteractivePreview(PF_InData* in_data)
+{
+	bool downsampled =
+		in_data->downsample_x.num < (A_long)in_data->downsample_x.den ||
+		in_data->downsample_y.num < (A_long)in_data->downsample_y.den;
+
+	if (in_data->quality != PF_Quality_LO && !downsampled) {
+		return false;
+	}
+
+	AEGP_RenderQueueState state = AEGP_RenderQueueState_RENDERING;
+
+	try {
+		AEGP_SuiteHandler suites(in_data->pica_basicP);
+		if (suites.RenderQueueSuite1()->AEGP_GetRenderQueueState(&state) != A_Err_NONE) {
+			return false;
 		}
 	}
+	catch (...) {
+		return false;
+	}
+
+	return state != AEGP_RenderQueueState_RENDERING;
 }
 
+// Tier changes go to the OS console (Console.app / DebugView)
+static void
+LogGovernorTier(PF_InData* in_data, A_long tier, PF_FpLong averageMs, PF_FpLong budgetMs)
+{
+	static const char* tierNames[GOVERNOR_NUM_TIERS] = {
+		"full quality", "half resolution", "ordered dither"
+	};
+
+	A_char message[256];
+	snprintf(message, sizeof(message), "PunkDither preview governor: %s (recent avg %.1f ms, budget %.1f ms)",
+		tierNames[tier], averageMs, budgetMs);
+
+	try {
+		AEGP_SuiteHandler suites(in_data->pica_basicP);
+		suites.UtilitySuite6()->AEGP_WriteToOSConsole(message);
+	}
+	catch (...) {
+		fprintf(stderr, "%s\n", message);
+	}
+}
+
+// Records a preview render time and moves one tier down when the recent
+// average misses the budget, or back up once there is plenty of headroom.
+// History is cleared on every change so each tier is judged on its own.
+static void
+UpdateGovernor(PF_InData* in_data, PunkDitherSequenceData* seqP, PF_FpLong renderMs, PF_FpLong budgetMs)
+{
+	seqP->renderMs[seqP->governorNext] = renderMs;
+	seqP->governorNext = (seqP->governorNext + 1) % GOVERNOR_HISTORY;
+	seqP->governorSamples = MIN(GOVERNOR_HISTORY, seqP->governorSamples + 1);
+
+	if (seqP->governorSamples < 3) return;  // Let the tier settle first
+
+	PF_FpLong averageMs = 0;
+	for (A_long i = 0; i < seqP->governorSamples; i++) {
+		averageMs += seqP->renderMs[i];
+	}
+	averageMs /= seqP->governorSamples;
+
+	A_long tier = seqP->governorTier;
+	if (averageMs > budgetMs && tier < GOVERNOR_NUM_TIERS - 1) {
+		tier++;
+	}
+	else if (averageMs < budgetMs * 0.5 && tier > GOVERNOR_TIER_FULL) {
+		tier--;
+	}
+
+	if (tier != seqP->governorTier) {
+		seqP->governorTier = tier;
+		seqP->governorSamples = 0;
+		seqP->governorNext = 0;
+		LogGovernorTier(in_data, tier, averageMs, budgetMs);
+	}
+}
 
 
 static PF_Err Render(PF_InData* in_data, PF_OutData* out_data, PF_ParamDef* params[], PF_LayerDef* output) {
     PF_Err err = PF_Err_NONE;
+    std::chrono::steady_clock::time_point renderStart = std::chrono::steady_clock::now();
 
     PF_LayerDef* input = &params[0]->u.ld;
 
@@ -482,17 +754,110 @@ static PF_Err Render(PF_InData* in_data, PF_OutData* out_data, PF_ParamDef* para
     // 🎯 Step 3: Get UI Parameters
     PunkDitherParams dither;
     dither.strength = params[1]->u.fs_d.value;
-    dither.colorA = params[2]->u.cd.value;
-    dither.colorB = params[3]->u.cd.value;
+    dither.colorA = ToPunkPixel(params[2]->u.cd.value);
+    dither.colorB = ToPunkPixel(params[3]->u.cd.value);
     dither.algorithm = params[6]->u.pd.value;
+    dither.sharpenAmount = params[PUNKDITHER_SHARPEN_AMOUNT]->u.fs_d.value;
+    dither.sharpenRadius = ScaleRadius(params[PUNKDITHER_SHARPEN_RADIUS]->u.sd.value, in_data->downsample_x);
+    dither.sharpenRadiusY = ScaleRadius(params[PUNKDITHER_SHARPEN_RADIUS]->u.sd.value, in_data->downsample_y);
+    dither.noiseSeed = (uint32_t)params[PUNKDITHER_NOISE_SEED]->u.sd.value;
+    dither.noiseFrame = 0;
+    if (params[PUNKDITHER_NOISE_ANIMATE]->u.bd.value && in_data->time_step != 0) {
+        dither.noiseFrame = in_data->current_time / in_data->time_step;
+    }
+
+    dither.thresholdMap = NULL;
+    dither.mapWidth = 0;
+    dither.mapHeight = 0;
+    dither.projectionLUT = NULL;
 
     int ditherDirection = params[4]->u.pd.value;
 
-    // 🎛 Step 4: Apply Selected Dithering Algorithm
-    switch (dither.algorithm) {
-        case 1: ApplyPunkDither(output, &dither, ditherDirection); break;
-        case 2: ApplyBayerDither(output, &dither); break;
-        case 3: ApplyBlueNoiseDither(output, &dither); break;
+    AEGP_SuiteHandler suites(in_data->pica_basicP);
+    PunkDitherSequenceData* seqP = NULL;
+    if (in_data->sequence_data) {
+        seqP = reinterpret_cast<PunkDitherSequenceData*>(suites.HandleSuite1()->host_lock_handle(in_data->sequence_data));
+    }
+
+    // 🗺 Step 3.25: Check out the Threshold Map layer and fetch its cached luma tile
+    PF_ParamDef mapParam;
+    AEFX_CLR_STRUCT(mapParam);
+    bool mapCheckedOut = false;
+
+    if (dither.algorithm == 5 && seqP) {
+        err = PF_CHECKOUT_PARAM(in_data, PUNKDITHER_MAP_LAYER,
+            in_data->current_time, in_data->time_step, in_data->time_scale, &mapParam);
+        mapCheckedOut = !err;
+
+        if (!err && mapParam.u.ld.data && mapParam.u.ld.width > 0 && mapParam.u.ld.height > 0) {
+            err = PrepareThresholdMap(in_data, seqP,
+                &mapParam.u.ld,
+                params[PUNKDITHER_MAP_SCALE]->u.fs_d.value,
+                params[PUNKDITHER_MAP_OFFSET]->u.fs_d.value,
+                &dither.thresholdMap);
+            dither.mapWidth = seqP->mapWidth;
+            dither.mapHeight = seqP->mapHeight;
+        }
+    }
+
+    // 🌈 Step 3.5: Perceptual mode thresholds each pixel's OKLab position between the colors
+    if (!err && seqP && params[PUNKDITHER_COLOR_MODE]->u.pd.value == 2) {
+        err = PrepareProjectionLUT(in_data, seqP,
+            params[2]->u.cd.value,
+            params[3]->u.cd.value,
+            &dither.projectionLUT);
+    }
+
+    // ⏱ Step 3.75: Preview governor picks a cheaper tier when previews run late
+    bool governing = false;
+    A_long tier = GOVERNOR_TIER_FULL;
+    if (seqP) {
+        if (!params[PUNKDITHER_GOVERNOR]->u.bd.value) {
+            seqP->governorTier = GOVERNOR_TIER_FULL;
+            seqP->governorSamples = 0;
+            seqP->governorNext = 0;
+        }
+        else if (IsInteractivePreview(in_data)) {
+            governing = true;
+            tier = seqP->governorTier;
+        }
+    }
+
+    if (tier >= GOVERNOR_TIER_ORDERED && (dither.algorithm == 1 || dither.algorithm == 3)) {
+        dither.algorithm = 2;
+    }
+
+    // 🎛 Step 4: Pre-sharpen, then Apply Selected Dithering Algorithm
+    if (!err) {
+        PunkBuffer buffer;
+        buffer.data = output->data;
+        buffer.width = output->extent_hint.right;
+        buffer.height = output->extent_hint.bottom;
+        buffer.rowbytes = output->rowbytes;
+
+        // Kept per render thread so steady-state renders don't allocate
+        static thread_local PunkDitherScratch scratch;
+        if (tier >= GOVERNOR_TIER_HALF_RES) {
+            RunPunkDitherCoarse(&buffer, &dither, ditherDirection, 2, &scratch);
+        }
+        else {
+            RunPunkDither(&buffer, &dither, ditherDirection, &scratch);
+        }
+    }
+
+    if (governing && !err) {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - renderStart;
+        UpdateGovernor(in_data, seqP, elapsed.count(), params[PUNKDITHER_GOVERNOR_BUDGET]->u.fs_d.value);
+    }
+
+    if (seqP) {
+        if (dither.thresholdMap) suites.HandleSuite1()->host_unlock_handle(seqP->mapH);
+        if (dither.projectionLUT) suites.HandleSuite1()->host_unlock_handle(seqP->projectionH);
+        suites.HandleSuite1()->host_unlock_handle(in_data->sequence_data);
+    }
+    if (mapCheckedOut) {
+        PF_Err checkinErr = PF_CHECKIN_PARAM(in_data, &mapParam);
+        if (!err) err = checkinErr;
     }
 
     return err;
@@ -568,6 +933,46 @@ EffectMain(
 				output);
 			break;
 
+		case PF_Cmd_SEQUENCE_SETUP:
+
+			err = SequenceSetup(in_data,
+				out_data,
+				params,
+				output);
+			break;
+
+		case PF_Cmd_SEQUENCE_RESETUP:
+
+			err = SequenceResetup(in_data,
+				out_data,
+				params,
+				output);
+			break;
+
+		case PF_Cmd_SEQUENCE_FLATTEN:
+
+			err = SequenceFlatten(in_data,
+				out_data,
+				params,
+				output);
+			break;
+
+		case PF_Cmd_SEQUENCE_SETDOWN:
+
+			err = SequenceSetdown(in_data,
+				out_data,
+				params,
+				output);
+			break;
+
+		case PF_Cmd_QUERY_DYNAMIC_FLAGS:
+
+			err = QueryDynamicFlags(in_data,
+				out_data,
+				params,
+				extra);
+			break;
+
 		case PF_Cmd_RENDER:
 
 			err = Render(in_data,
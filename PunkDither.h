@@ -58,6 +58,7 @@ typedef unsigned short PixelType;
 #include "AEGP_SuiteHandler.h"
 
 #include "PunkDither_Strings.h"
+#include "PunkDither_Kernels.h"
 
 /* Versioning information */
 
@@ -75,8 +76,19 @@ enum {
 	PUNKDITHER_COLOR_A,   // Dark Color
 	PUNKDITHER_COLOR_B,   // Bright Color
 	PUNKDITHER_DIRECTION, // Dither Direction (Up, Down, Left, Right)
-	PUNKDITHER_ALGORITHM, // Dithering Algorithm (Error Diffusion, Bayer, Blue Noise)
+	PUNKDITHER_WARNING,   // Non-editable "Avoid Pure Red" notice
+	PUNKDITHER_ALGORITHM, // Dithering Algorithm (Error Diffusion, Bayer, Blue Noise, White Noise, Threshold Map)
 	PUNKDITHER_DOWNSCALE, // Downscale Factor (1x to 32x)
+	PUNKDITHER_SHARPEN_AMOUNT, // Pre-sharpen Amount (0 = off)
+	PUNKDITHER_SHARPEN_RADIUS, // Pre-sharpen blur radius in pixels
+	PUNKDITHER_NOISE_SEED,     // White Noise seed
+	PUNKDITHER_NOISE_ANIMATE,  // White Noise re-rolls every frame
+	PUNKDITHER_MAP_LAYER,      // Layer used as a custom threshold map
+	PUNKDITHER_MAP_SCALE,      // Threshold map level scale
+	PUNKDITHER_MAP_OFFSET,     // Threshold map level offset
+	PUNKDITHER_GOVERNOR,       // Drop preview quality to hold the frame budget
+	PUNKDITHER_GOVERNOR_BUDGET, // Preview frame budget in milliseconds
+	PUNKDITHER_COLOR_MODE,     // Two-color level: Luma or Perceptual (OKLab)
 	PUNKDITHER_NUM_PARAMS
 };
 
@@ -84,14 +96,40 @@ enum {
 	DITHER_ID = 1 // 🎯 Only keeping dither param
 };
 
-/* Dithering Parameters */
-typedef struct PunkDitherParams {
-	PF_FpLong strength; // Dither intensity
-	PF_Pixel8 colorA;    // Dark Color
-	PF_Pixel8 colorB;    // Bright Color
-	int algorithm;       // Dithering Algorithm (1 = Error Diffusion, 2 = Bayer, 3 = Blue Noise)
-	int downscaleFactor; // Downscale Factor (1x, 2x, 3x, ..., 32x)
-} PunkDitherParams;
+/* Preview governor tiers, cheapest last. Each one must shorten this
+   effect's own render time, since that is what the governor measures. */
+enum {
+	GOVERNOR_TIER_FULL = 0,     // Untouched
+	GOVERNOR_TIER_HALF_RES,     // Dither at half resolution
+	GOVERNOR_TIER_ORDERED,      // ...and Bayer in place of diffusion / blue noise
+	GOVERNOR_NUM_TIERS
+};
+
+#define GOVERNOR_HISTORY	8	// Render times kept for the governor
+
+/* Per-instance state. The threshold map and projection caches are transient:
+   they are dropped on flatten and rebuilt on the next render. The map is keyed
+   on a fingerprint of the checked-out layer frame, so a static pattern layer
+   converts only once; the projection cube is rebaked when the colors change. */
+typedef struct PunkDitherSequenceData {
+	A_Boolean mapValid;  // mapH holds a converted tile for the key below
+	A_u_longlong mapSourceHash; // Fingerprint of the layer frame it came from
+	PF_FpLong mapScale;  // Level scale the tile was converted with
+	PF_FpLong mapOffset; // Level offset the tile was converted with
+	A_long mapWidth;
+	A_long mapHeight;
+	PF_Handle mapH;      // mapWidth * mapHeight luma bytes
+
+	A_long governorTier; // Current GOVERNOR_TIER_*
+	A_long governorSamples; // Valid entries in renderMs
+	A_long governorNext; // Next slot to write in renderMs
+	PF_FpLong renderMs[GOVERNOR_HISTORY]; // Recent preview render times at this tier
+
+	A_Boolean projectionValid; // projectionH holds the cube for the colors below
+	PF_Pixel8 projectionA;
+	PF_Pixel8 projectionB;
+	PF_Handle projectionH; // PUNK_PROJECTION_LUT_SIZE levels
+} PunkDitherSequenceData;
 
 typedef struct GainInfo {
 	PF_FpLong	gainF;
@@ -49,11 +49,11 @@ resource 'PiPL' (16000) {
 		},
 		/* [10] */
 		AE_Effect_Global_OutFlags {
-		0x02000000 //50332160
+		0x02000014 // DEEP_COLOR_AWARE | SEQUENCE_DATA_NEEDS_FLATTENING | NON_PARAM_VARY
 
 		},
 		AE_Effect_Global_OutFlags_2 {
-		0x00000000
+		0x00000001 // SUPPORTS_QUERY_DYNAMIC_FLAGS
 		},
 		/* [11] */
 		AE_Effect_Match_Name {
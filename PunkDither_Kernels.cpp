@@ -0,0 +1,569 @@
+/*
+	PunkDither_Kernels.cpp
+
+	Host-independent dither kernels shared by the After Effects effect
+	and the punkdither-stream filter.
+*/
+
+#include "PunkDither_Kernels.h"
+#include <vector>
+#include <algorithm>
+#include <omp.h> // OpenMP for parallel processing
+#include <random>
+#include <cmath>
+
+#ifndef MIN
+#define MIN(A, B)	(((A) < (B)) ? (A) : (B))
+#endif
+#ifndef MAX
+#define MAX(A, B)	(((A) > (B)) ? (A) : (B))
+#endif
+
+// The 0..255 level each kernel thresholds: the colorA->colorB projection
+// cube when one is baked, otherwise the plain channel average.
+static inline int DitherLevel(const PunkDitherParams* params, const PunkPixel8* pixel) {
+	if (params->projectionLUT) {
+		return params->projectionLUT[PUNK_PROJECTION_INDEX(pixel->red, pixel->green, pixel->blue)];
+	}
+	return (pixel->red + pixel->green + pixel->blue) / 3;
+}
+
+static inline double SrgbToLinear(double c) {
+	return c <= 0.04045 ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4);
+}
+
+// Linear sRGB to OKLab, using Bjorn Ottosson's reference matrices
+static inline void LinearToOklab(double r, double g, double b, double lab[3]) {
+	double l = cbrt(0.4122214708 * r + 0.5363325363 * g + 0.0514459929 * b);
+	double m = cbrt(0.2119034982 * r + 0.6806995451 * g + 0.1073969566 * b);
+	double s = cbrt(0.0883024619 * r + 0.2817188376 * g + 0.6299787005 * b);
+
+	lab[0] = 0.2104542553 * l + 0.7936177850 * m - 0.0040720468 * s;
+	lab[1] = 1.9779984951 * l - 2.4285922050 * m + 0.4505937099 * s;
+	lab[2] = 0.0259040371 * l + 0.7827717662 * m - 0.8086757660 * s;
+}
+
+static inline void PixelToOklab(const PunkPixel8& color, double lab[3]) {
+	LinearToOklab(SrgbToLinear(color.red / 255.0),
+		SrgbToLinear(color.green / 255.0),
+		SrgbToLinear(color.blue / 255.0),
+		lab);
+}
+
+void BuildProjectionLUT(uint8_t* lut, PunkPixel8 colorA, PunkPixel8 colorB) {
+	double labA[3], labB[3], axis[3];
+	PixelToOklab(colorA, labA);
+	PixelToOklab(colorB, labB);
+
+	double axisLength2 = 0.0;
+	for (int c = 0; c < 3; c++) {
+		axis[c] = labB[c] - labA[c];
+		axisLength2 += axis[c] * axis[c];
+	}
+
+	// Each cell covers 8 input levels (i*8 .. i*8+7). Interior cells are
+	// sampled at their centre so quantization error is symmetric; the end
+	// cells keep the exact 0 and 255 levels, since OKLab is steep near black
+	// and a centre sample there would lift pure black well above colorA.
+	double level[PUNK_PROJECTION_STEPS], linear[PUNK_PROJECTION_STEPS];
+	for (int i = 0; i < PUNK_PROJECTION_STEPS; i++) {
+		if (i == 0) level[i] = 0.0;
+		else if (i == PUNK_PROJECTION_STEPS - 1) level[i] = 255.0;
+		else level[i] = 8 * i + 3.5;
+		linear[i] = SrgbToLinear(level[i] / 255.0);
+	}
+
+#pragma omp parallel for schedule(static)
+	for (int r = 0; r < PUNK_PROJECTION_STEPS; r++) {
+		for (int g = 0; g < PUNK_PROJECTION_STEPS; g++) {
+			for (int b = 0; b < PUNK_PROJECTION_STEPS; b++) {
+				double t;
+				if (axisLength2 > 1e-12) {
+					double lab[3];
+					LinearToOklab(linear[r], linear[g], linear[b], lab);
+					t = ((lab[0] - labA[0]) * axis[0] +
+						(lab[1] - labA[1]) * axis[1] +
+						(lab[2] - labA[2]) * axis[2]) / axisLength2;
+				}
+				else {
+					t = (level[r] + level[g] + level[b]) / (3.0 * 255.0);  // colorA == colorB: fall back to average
+				}
+				lut[(r << 10) | (g << 5) | b] = (uint8_t)(MIN(1.0, MAX(0.0, t)) * 255.0 + 0.5);
+			}
+		}
+	}
+
+	// The cells holding the two colors themselves must render as those colors
+	int cellA = PUNK_PROJECTION_INDEX(colorA.red, colorA.green, colorA.blue);
+	int cellB = PUNK_PROJECTION_INDEX(colorB.red, colorB.green, colorB.blue);
+	if (cellA != cellB) {
+		lut[cellA] = 0;
+		lut[cellB] = 255;
+	}
+}
+
+// Improved 8x8 Bayer matrix for smoother dithering
+const int bayerMatrix8x8[8][8] = {
+	{  0, 32,  8, 40,  2, 34, 10, 42 },
+	{ 48, 16, 56, 24, 50, 18, 58, 26 },
+	{ 12, 44,  4, 36, 14, 46,  6, 38 },
+	{ 60, 28, 52, 20, 62, 30, 54, 22 },
+	{  3, 35, 11, 43,  1, 33,  9, 41 },
+	{ 51, 19, 59, 27, 49, 17, 57, 25 },
+	{ 15, 47,  7, 39, 13, 45,  5, 37 },
+	{ 63, 31, 55, 23, 61, 29, 53, 21 }
+};
+
+void ApplyBayerDither(PunkBuffer* output, const PunkDitherParams* params) {
+	int width = output->width;
+	int height = output->height;
+	int rowbytes = output->rowbytes;
+
+	float strength = params->strength * 4.0f; // Adjust dither intensity based on slider
+
+#pragma omp parallel for schedule(dynamic)
+	for (int y = 0; y < height; y++) {
+		PunkPixel8* row = (PunkPixel8*)((char*)output->data + y * rowbytes);
+		for (int x = 0; x < width; x++) {
+			PunkPixel8* pixel = &row[x];
+			int threshold = bayerMatrix8x8[y % 8][x % 8] * strength; // Adjust with slider strength
+			int grayscale = DitherLevel(params, pixel);
+			bool ditherMask = grayscale > threshold;
+			pixel->red = ditherMask ? params->colorB.red : params->colorA.red;
+			pixel->green = ditherMask ? params->colorB.green : params->colorA.green;
+			pixel->blue = ditherMask ? params->colorB.blue : params->colorA.blue;
+		}
+	}
+}
+
+
+void ApplyBlueNoiseDither(PunkBuffer* output, const PunkDitherParams* params, PunkDitherScratch* scratch) {
+	int width = output->width;
+	int height = output->height;
+	int rowbytes = output->rowbytes;
+	std::vector<int>& noise = scratch->noise;
+	noise.resize((size_t)width * height);
+
+	std::random_device rd;
+	std::mt19937 gen(rd());
+	std::uniform_int_distribution<int> dis(0, 255);
+
+	for (int i = 0; i < width * height; i++) {
+		noise[i] = dis(gen);
+	}
+
+	for (int y = 0; y < height; y++) {
+		PunkPixel8* row = (PunkPixel8*)((char*)output->data + y * rowbytes);
+		for (int x = 0; x < width; x++) {
+			PunkPixel8* pixel = &row[x];
+			int grayscale = DitherLevel(params, pixel);
+			int threshold = noise[y * width + x] * params->strength;
+			bool ditherMask = grayscale > threshold;
+			pixel->red = ditherMask ? params->colorB.red : params->colorA.red;
+			pixel->green = ditherMask ? params->colorB.green : params->colorA.green;
+			pixel->blue = ditherMask ? params->colorB.blue : params->colorA.blue;
+		}
+	}
+}
+
+// Dithers against an 8-bit luma tile taken from the Threshold Map layer,
+// repeated across the frame at its native pixel size.
+void ApplyThresholdMapDither(PunkBuffer* output, const PunkDitherParams* params) {
+	int width = output->width;
+	int height = output->height;
+	int rowbytes = output->rowbytes;
+	int mapWidth = params->mapWidth;
+	int mapHeight = params->mapHeight;
+
+	float strength = (float)params->strength;
+
+#pragma omp parallel for schedule(static)
+	for (int y = 0; y < height; y++) {
+		PunkPixel8* row = (PunkPixel8*)((char*)output->data + y * rowbytes);
+		const uint8_t* mapRow = params->thresholdMap + (y % mapHeight) * mapWidth;
+
+		for (int x = 0, mx = 0; x < width; x++) {
+			PunkPixel8* pixel = &row[x];
+			int grayscale = DitherLevel(params, pixel);
+			int threshold = (int)(mapRow[mx] * strength);
+			bool ditherMask = grayscale > threshold;
+			pixel->red = ditherMask ? params->colorB.red : params->colorA.red;
+			pixel->green = ditherMask ? params->colorB.green : params->colorA.green;
+			pixel->blue = ditherMask ? params->colorB.blue : params->colorA.blue;
+			if (++mx == mapWidth) mx = 0;
+		}
+	}
+}
+
+// Stateless 32-bit integer mix (lowbias32). Chaining it over seed, frame, y
+// and x gives every pixel its own noise value with no shared generator state,
+// so rows can run on any thread and any machine and still match bit for bit.
+static inline uint32_t HashNoise32(uint32_t h) {
+	h ^= h >> 16;
+	h *= 0x7feb352dU;
+	h ^= h >> 15;
+	h *= 0x846ca68bU;
+	h ^= h >> 16;
+	return h;
+}
+
+void ApplyWhiteNoiseDither(PunkBuffer* output, const PunkDitherParams* params) {
+	int width = output->width;
+	int height = output->height;
+	int rowbytes = output->rowbytes;
+
+	uint32_t frameKey = HashNoise32((uint32_t)params->noiseFrame + HashNoise32((uint32_t)params->noiseSeed));
+	float strength = (float)params->strength;
+
+#pragma omp parallel for schedule(static)
+	for (int y = 0; y < height; y++) {
+		PunkPixel8* row = (PunkPixel8*)((char*)output->data + y * rowbytes);
+		uint32_t rowKey = HashNoise32((uint32_t)y + frameKey);
+
+#pragma omp simd
+		for (int x = 0; x < width; x++) {
+			PunkPixel8* pixel = &row[x];
+			int grayscale = DitherLevel(params, pixel);
+			int threshold = (int)((HashNoise32((uint32_t)x + rowKey) & 0xFF) * strength);
+			bool ditherMask = grayscale > threshold;
+			pixel->red = ditherMask ? params->colorB.red : params->colorA.red;
+			pixel->green = ditherMask ? params->colorB.green : params->colorA.green;
+			pixel->blue = ditherMask ? params->colorB.blue : params->colorA.blue;
+		}
+	}
+}
+
+
+// Scales a diffused error (in 0..255 level units) onto one channel
+static inline int SpreadError(int err, int spread) {
+	return err * spread / 255;
+}
+
+void ApplyPunkDither(PunkBuffer* output, const PunkDitherParams* params, int direction) {
+	if (params->strength < 0.01) return;
+
+	int width = output->width;
+	int height = output->height;
+	int rowbytes = output->rowbytes;
+	double strength = MAX(0.05, params->strength);
+
+	// Where diffused error goes. In Luma mode all three channels move together.
+	// In Perceptual mode the error is measured along colorA->colorB, so it is
+	// pushed along that RGB direction; moving all channels equally would mostly
+	// change the neighbour's lightness, not its position between the colors.
+	int spreadR = 255, spreadG = 255, spreadB = 255;
+	if (params->projectionLUT) {
+		spreadR = params->colorB.red - params->colorA.red;
+		spreadG = params->colorB.green - params->colorA.green;
+		spreadB = params->colorB.blue - params->colorA.blue;
+	}
+
+	if (direction == 1) {  // 🔼 UP - Process bottom to top (Unmodified)
+		for (int y = height - 1; y > 0; y--) {
+			PunkPixel8* row = (PunkPixel8*)((char*)output->data + y * rowbytes);
+			PunkPixel8* rowAbove = (PunkPixel8*)((char*)output->data + (y - 1) * rowbytes);
+
+			for (int x = 1; x < width - 1; x++) {
+				PunkPixel8* pixel = &row[x];
+				int grayscale = DitherLevel(params, pixel);
+				int threshold = 128 * (1.0 - strength);
+				threshold = MAX(64, MIN(192, threshold));
+				bool ditherMask = (grayscale > threshold);
+				int ditherValue = ditherMask ? 255 : 0;
+				int err = grayscale - ditherValue;
+				int diffusionFactor = 8 + (8 * strength);
+
+				if (y > 0) {
+					rowAbove[x].red = MIN(255, MAX(0, rowAbove[x].red + SpreadError(err * 8 / diffusionFactor, spreadR)));
+					rowAbove[x].green = MIN(255, MAX(0, rowAbove[x].green + SpreadError(err * 8 / diffusionFactor, spreadG)));
+					rowAbove[x].blue = MIN(255, MAX(0, rowAbove[x].blue + SpreadError(err * 8 / diffusionFactor, spreadB)));
+				}
+				pixel->red = ditherMask ? params->colorB.red : params->colorA.red;
+				pixel->green = ditherMask ? params->colorB.green : params->colorA.green;
+				pixel->blue = ditherMask ? params->colorB.blue : params->colorA.blue;
+			}
+		}
+	}
+	else if (direction == 2) {  // 🔽 DOWN - Process top to bottom
+		for (int y = 0; y < height - 1; y++) {
+			PunkPixel8* row = (PunkPixel8*)((char*)output->data + y * rowbytes);
+			PunkPixel8* rowBelow = (PunkPixel8*)((char*)output->data + (y + 1) * rowbytes);
+
+			for (int x = 1; x < width - 1; x++) {
+				PunkPixel8* pixel = &row[x];
+				int grayscale = DitherLevel(params, pixel);
+				int threshold = 128 * (1.0 - strength);
+				threshold = MAX(64, MIN(192, threshold));
+				bool ditherMask = (grayscale > threshold);
+				int ditherValue = ditherMask ? 255 : 0;
+				int err = grayscale - ditherValue;
+				int diffusionFactor = 8 + (8 * strength);
+
+				if (y < height - 1) {
+					rowBelow[x].red = MIN(255, MAX(0, rowBelow[x].red + SpreadError(err * 8 / diffusionFactor, spreadR)));
+					rowBelow[x].green = MIN(255, MAX(0, rowBelow[x].green + SpreadError(err * 8 / diffusionFactor, spreadG)));
+					rowBelow[x].blue = MIN(255, MAX(0, rowBelow[x].blue + SpreadError(err * 8 / diffusionFactor, spreadB)));
+				}
+				pixel->red = ditherMask ? params->colorB.red : params->colorA.red;
+				pixel->green = ditherMask ? params->colorB.green : params->colorA.green;
+				pixel->blue = ditherMask ? params->colorB.blue : params->colorA.blue;
+			}
+		}
+	}
+	else if (direction == 3) {  // ◀ LEFT - FIXED (Prevents dithering issues with white)
+		if (strength > 0.01) {
+			for (int y = 0; y < height; y++) {
+				PunkPixel8* row = (PunkPixel8*)((char*)output->data + y * rowbytes);
+
+				for (int x = width - 1; x > 0; x--) {
+					PunkPixel8* pixel = &row[x];
+					int grayscale = DitherLevel(params, pixel);
+					int threshold = 128 * (1.0 - strength);
+					threshold = MAX(64, MIN(192, threshold));
+					bool ditherMask = (grayscale > threshold);
+					int ditherValue = ditherMask ? 255 : 0;
+					int err = grayscale - ditherValue;
+					int diffusionFactor = 8 + (8 * strength);
+
+					if (x > 0) {
+						row[x - 1].red = MIN(255, MAX(0, row[x - 1].red + SpreadError(err * 8 / diffusionFactor, spreadR)));
+						row[x - 1].green = MIN(255, MAX(0, row[x - 1].green + SpreadError(err * 8 / diffusionFactor, spreadG)));
+						row[x - 1].blue = MIN(255, MAX(0, row[x - 1].blue + SpreadError(err * 8 / diffusionFactor, spreadB)));
+					}
+
+					// 🛠 FIX: Properly handle bright pixels (Prevent unwanted dithering on white)
+					if (!params->projectionLUT && pixel->red > 240 && pixel->green > 240 && pixel->blue > 240) {
+						pixel->red = params->colorB.red;
+						pixel->green = params->colorB.green;
+						pixel->blue = params->colorB.blue;
+					}
+					else {
+						pixel->red = ditherMask ? params->colorB.red : params->colorA.red;
+						pixel->green = ditherMask ? params->colorB.green : params->colorA.green;
+						pixel->blue = ditherMask ? params->colorB.blue : params->colorA.blue;
+					}
+				}
+			}
+		}
+	}
+	else if (direction == 4) {  // ▶ RIGHT - Unchanged
+		for (int y = 0; y < height; y++) {
+			PunkPixel8* row = (PunkPixel8*)((char*)output->data + y * rowbytes);
+
+			for (int x = 0; x < width - 1; x++) {
+				PunkPixel8* pixel = &row[x];
+				int grayscale = DitherLevel(params, pixel);
+				int threshold = 128 * (1.0 - strength);
+				threshold = MAX(64, MIN(192, threshold));
+				bool ditherMask = (grayscale > threshold);
+				int ditherValue = ditherMask ? 255 : 0;
+				int err = grayscale - ditherValue;
+				int diffusionFactor = 8 + (8 * strength);
+
+				if (x < width - 1) {
+					row[x + 1].red = MIN(255, MAX(0, row[x + 1].red + SpreadError(err * 8 / diffusionFactor, spreadR)));
+					row[x + 1].green = MIN(255, MAX(0, row[x + 1].green + SpreadError(err * 8 / diffusionFactor, spreadG)));
+					row[x + 1].blue = MIN(255, MAX(0, row[x + 1].blue + SpreadError(err * 8 / diffusionFactor, spreadB)));
+				}
+				pixel->red = ditherMask ? params->colorB.red : params->colorA.red;
+				pixel->green = ditherMask ? params->colorB.green : params->colorA.green;
+				pixel->blue = ditherMask ? params->colorB.blue : params->colorA.blue;
+			}
+		}
+	}
+}
+
+// Horizontal box sum of one row's luma, edges clamped. lp is a padded line
+// buffer with room for radius entries on the left and radius + 1 on the right.
+static inline void BoxSumRow(const PunkPixel8* row, int width, int radius, int* lp, int* dst) {
+#pragma omp simd
+	for (int x = 0; x < width; x++) {
+		lp[x] = (row[x].red + row[x].green + row[x].blue) / 3;
+	}
+	for (int i = 1; i <= radius; i++) {
+		lp[-i] = lp[0];
+		lp[width - 1 + i] = lp[width - 1];
+	}
+	lp[width + radius] = lp[width - 1];
+
+	int sum = 0;
+	for (int i = -radius; i <= radius; i++) sum += lp[i];
+	for (int x = 0; x < width; x++) {
+		dst[x] = sum;
+		sum += lp[x + radius + 1] - lp[x - radius];
+	}
+}
+
+// Unsharp mask on the luma, applied in place before thresholding.
+// The blur is a separable running-sum box filter fused with the sharpen write.
+// Each thread owns a band of rows and keeps only a rolling window of
+// 2 * radiusY + 1 horizontal row sums, plus the radiusY + 1 rows just below its
+// band, which are summed before the barrier because the next band's thread
+// overwrites them. Memory is a few rows per thread, never a full frame, and
+// no intermediate layer is ever handed to the host.
+void ApplyPreSharpen(PunkBuffer* output, const PunkDitherParams* params, PunkDitherScratch* scratch) {
+	if (params->sharpenAmount <= 0.0) return;  // Amount = 0 costs nothing
+
+	int width = output->width;
+	int height = output->height;
+	int rowbytes = output->rowbytes;
+	if (width <= 0 || height <= 0) return;
+
+	int radiusX = MAX(0, MIN(64, params->sharpenRadius));
+	int radiusY = MAX(0, MIN(64, params->sharpenRadiusY));
+	if (radiusX == 0 && radiusY == 0) return;  // A 1x1 blur sharpens nothing
+
+	float amount = (float)params->sharpenAmount;
+	float norm = 1.0f / (float)((2 * radiusX + 1) * (2 * radiusY + 1));
+
+	int maxThreads = omp_get_max_threads();
+	int lineLength = width + 2 * radiusX + 1;
+	int windowLength = 2 * radiusY + 1;
+	size_t threadRows = (size_t)windowLength + radiusY + 1;
+	scratch->lineBuffers.resize((size_t)lineLength * maxThreads);
+	scratch->windowRows.resize(threadRows * width * maxThreads);
+	scratch->colSums.resize((size_t)width * maxThreads);
+
+#pragma omp parallel
+	{
+		int threads = omp_get_num_threads();
+		int t = omp_get_thread_num();
+		int y0 = (int)((long long)height * t / threads);
+		int y1 = (int)((long long)height * (t + 1) / threads);
+
+		int* lp = scratch->lineBuffers.data() + (size_t)lineLength * t + radiusX;
+		int* window = scratch->windowRows.data() + threadRows * width * t;
+		int* below = window + (size_t)windowLength * width;
+		int* cs = scratch->colSums.data() + (size_t)width * t;
+
+		// Step 1: Sum every row this band reads that another thread may write
+		if (y0 < y1) {
+			for (int j = 0; j < windowLength; j++) {
+				int y = MAX(0, MIN(height - 1, y0 - radiusY + j));
+				const PunkPixel8* row = (const PunkPixel8*)((char*)output->data + y * rowbytes);
+				BoxSumRow(row, width, radiusX, lp, window + (size_t)j * width);
+			}
+			if (y1 < height) {
+				for (int k = 0; k <= radiusY; k++) {
+					int y = MIN(height - 1, y1 + k);
+					const PunkPixel8* row = (const PunkPixel8*)((char*)output->data + y * rowbytes);
+					BoxSumRow(row, width, radiusX, lp, below + (size_t)k * width);
+				}
+			}
+		}
+
+#pragma omp barrier
+
+		// Step 2: Slide the vertical sum down the band, sharpening as it goes
+		if (y0 < y1) {
+			std::fill(cs, cs + width, 0);
+			for (int j = 0; j < windowLength; j++) {
+				const int* src = window + (size_t)j * width;
+#pragma omp simd
+				for (int x = 0; x < width; x++) cs[x] += src[x];
+			}
+
+			for (int y = y0; y < y1; y++) {
+				PunkPixel8* row = (PunkPixel8*)((char*)output->data + y * rowbytes);
+
+#pragma omp simd
+				for (int x = 0; x < width; x++) {
+					PunkPixel8* pixel = &row[x];
+					int grayscale = (pixel->red + pixel->green + pixel->blue) / 3;
+					int detail = (int)(amount * (grayscale - cs[x] * norm));
+					pixel->red = MIN(255, MAX(0, pixel->red + detail));
+					pixel->green = MIN(255, MAX(0, pixel->green + detail));
+					pixel->blue = MIN(255, MAX(0, pixel->blue + detail));
+				}
+
+				if (y + 1 < y1) {
+					// The row leaving the window and the one entering share a slot
+					int* slot = window + (size_t)((y - y0) % windowLength) * width;
+					int entering = MIN(height - 1, y + radiusY + 1);
+
+#pragma omp simd
+					for (int x = 0; x < width; x++) cs[x] -= slot[x];
+
+					if (entering < y1) {
+						// Still untouched: rows below y in this band are written later
+						const PunkPixel8* src = (const PunkPixel8*)((char*)output->data + entering * rowbytes);
+						BoxSumRow(src, width, radiusX, lp, slot);
+					}
+					else {
+						std::copy(below + (size_t)(entering - y1) * width,
+							below + (size_t)(entering - y1 + 1) * width, slot);
+					}
+
+#pragma omp simd
+					for (int x = 0; x < width; x++) cs[x] += slot[x];
+				}
+			}
+		}
+	}
+}
+
+
+
+void RunPunkDither(PunkBuffer* output, const PunkDitherParams* params, int direction, PunkDitherScratch* scratch) {
+	// 🔪 Pre-sharpen in place so fine detail survives thresholding
+	ApplyPreSharpen(output, params, scratch);
+
+	// 🎛 Apply Selected Dithering Algorithm
+	switch (params->algorithm) {
+		case 1: ApplyPunkDither(output, params, direction); break;
+		case 2: ApplyBayerDither(output, params); break;
+		case 3: ApplyBlueNoiseDither(output, params, scratch); break;
+		case 4: ApplyWhiteNoiseDither(output, params); break;
+		case 5:
+			if (params->thresholdMap) ApplyThresholdMapDither(output, params);
+			else ApplyBayerDither(output, params);  // No map layer picked
+			break;
+	}
+}
+
+void RunPunkDitherCoarse(PunkBuffer* output, const PunkDitherParams* params, int direction, int factor, PunkDitherScratch* scratch) {
+	int width = output->width;
+	int height = output->height;
+	int rowbytes = output->rowbytes;
+	int coarseWidth = (width + factor - 1) / MAX(1, factor);
+	int coarseHeight = (height + factor - 1) / MAX(1, factor);
+
+	if (factor <= 1 || coarseWidth <= 0 || coarseHeight <= 0) {
+		RunPunkDither(output, params, direction, scratch);
+		return;
+	}
+
+	scratch->coarse.resize((size_t)coarseWidth * coarseHeight);
+	PunkPixel8* coarse = scratch->coarse.data();
+
+	// Step 1: Downscale - Sample nearest pixel without averaging
+#pragma omp parallel for schedule(static)
+	for (int y = 0; y < coarseHeight; y++) {
+		const PunkPixel8* src = (const PunkPixel8*)((char*)output->data + y * factor * rowbytes);
+		PunkPixel8* dst = coarse + (size_t)y * coarseWidth;
+		for (int x = 0; x < coarseWidth; x++) {
+			dst[x] = src[x * factor];
+		}
+	}
+
+	PunkBuffer coarseBuffer;
+	coarseBuffer.data = coarse;
+	coarseBuffer.width = coarseWidth;
+	coarseBuffer.height = coarseHeight;
+	coarseBuffer.rowbytes = coarseWidth * (int)sizeof(PunkPixel8);
+
+	PunkDitherParams coarseParams = *params;
+	coarseParams.sharpenRadius = (params->sharpenRadius + factor / 2) / factor;
+	coarseParams.sharpenRadiusY = (params->sharpenRadiusY + factor / 2) / factor;
+	RunPunkDither(&coarseBuffer, &coarseParams, direction, scratch);
+
+	// Step 2: Upscale - Restore to original size using nearest-neighbor
+#pragma omp parallel for schedule(static)
+	for (int y = 0; y < height; y++) {
+		PunkPixel8* dst = (PunkPixel8*)((char*)output->data + y * rowbytes);
+		const PunkPixel8* src = coarse + (size_t)(y / factor) * coarseWidth;
+		for (int x = 0; x < width; x++) {
+			dst[x] = src[x / factor];
+		}
+	}
+}
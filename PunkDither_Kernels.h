@@ -0,0 +1,84 @@
+/*
+	PunkDither_Kernels.h
+
+	Host-independent pixel types and dither kernels. Nothing in here
+	depends on the After Effects SDK, so the same code runs inside the
+	effect and in the punkdither-stream command line filter.
+*/
+
+#pragma once
+
+#ifndef PUNKDITHER_KERNELS_H
+#define PUNKDITHER_KERNELS_H
+
+#include <cstdint>
+#include <vector>
+
+/* Same ARGB layout as PF_Pixel8, so AE worlds are processed in place */
+typedef struct PunkPixel8 {
+	uint8_t alpha;
+	uint8_t red;
+	uint8_t green;
+	uint8_t blue;
+} PunkPixel8;
+
+/* Two-color projection cube: 32 steps per channel, indexed by the top
+   five bits of red, green and blue */
+#define PUNK_PROJECTION_STEPS		32
+#define PUNK_PROJECTION_LUT_SIZE	(PUNK_PROJECTION_STEPS * PUNK_PROJECTION_STEPS * PUNK_PROJECTION_STEPS)
+#define PUNK_PROJECTION_INDEX(R, G, B)	((((R) >> 3) << 10) | (((G) >> 3) << 5) | ((B) >> 3))
+
+/* An 8-bit ARGB image the kernels work on in place */
+typedef struct PunkBuffer {
+	void* data;
+	int width;     // Pixels processed per row
+	int height;    // Rows processed
+	int rowbytes;  // Bytes from one row to the next
+} PunkBuffer;
+
+/* Dithering Parameters */
+typedef struct PunkDitherParams {
+	double strength;     // Dither intensity
+	PunkPixel8 colorA;   // Dark Color
+	PunkPixel8 colorB;   // Bright Color
+	int algorithm;       // Dithering Algorithm (1 = Error Diffusion, 2 = Bayer, 3 = Blue Noise, 4 = White Noise, 5 = Threshold Map)
+	int downscaleFactor; // Downscale Factor (1x, 2x, 3x, ..., 32x)
+	double sharpenAmount; // Unsharp mask gain applied before thresholding
+	int sharpenRadius;   // Horizontal box blur radius used by the unsharp mask
+	int sharpenRadiusY;  // Vertical radius (differs from sharpenRadius for non-square downsampling)
+	uint32_t noiseSeed;  // White Noise seed
+	int32_t noiseFrame;  // Frame index hashed into White Noise (0 when not animated)
+	const uint8_t* thresholdMap; // 8-bit luma tile from the map layer (NULL = none)
+	int mapWidth;        // Threshold map tile width
+	int mapHeight;       // Threshold map tile height
+	const uint8_t* projectionLUT; // PUNK_PROJECTION_LUT_SIZE levels (NULL = channel average)
+} PunkDitherParams;
+
+/* Grow-only working memory for the kernels. A caller that keeps one alive
+   across frames of the same size renders without allocating. */
+struct PunkDitherScratch {
+	std::vector<int> lineBuffers; // Pre-sharpen padded luma line, one per thread
+	std::vector<int> windowRows;  // Pre-sharpen rolling row sums + band halo, one set per thread
+	std::vector<int> colSums;     // Pre-sharpen vertical running sums, one per thread
+	std::vector<int> noise;       // Blue Noise thresholds
+	std::vector<PunkPixel8> coarse; // Reduced-resolution working copy
+};
+
+void ApplyPreSharpen(PunkBuffer* output, const PunkDitherParams* params, PunkDitherScratch* scratch);
+void ApplyPunkDither(PunkBuffer* output, const PunkDitherParams* params, int direction);
+void ApplyBayerDither(PunkBuffer* output, const PunkDitherParams* params);
+void ApplyBlueNoiseDither(PunkBuffer* output, const PunkDitherParams* params, PunkDitherScratch* scratch);
+void ApplyWhiteNoiseDither(PunkBuffer* output, const PunkDitherParams* params);
+void ApplyThresholdMapDither(PunkBuffer* output, const PunkDitherParams* params);
+
+/* Bakes each RGB cell's position along colorA->colorB in OKLab, as 0..255 */
+void BuildProjectionLUT(uint8_t* lut, PunkPixel8 colorA, PunkPixel8 colorB);
+
+/* Pre-sharpen followed by the selected algorithm */
+void RunPunkDither(PunkBuffer* output, const PunkDitherParams* params, int direction, PunkDitherScratch* scratch);
+
+/* Same as RunPunkDither, but at 1/factor resolution, scaled back up with
+   nearest neighbour. Used to trade detail for speed. */
+void RunPunkDitherCoarse(PunkBuffer* output, const PunkDitherParams* params, int direction, int factor, PunkDitherScratch* scratch);
+
+#endif // PUNKDITHER_KERNELS_H
@@ -0,0 +1,669 @@
+/*
+	PunkDither_Stream.cpp
+
+	punkdither-stream: runs the PunkDither kernels on raw video piped
+	through stdin/stdout, for use between two ffmpeg processes:
+
+		ffmpeg -i in.mov -f rawvideo -pix_fmt rgba - |
+			punkdither-stream -s 3840x2160 -f rgba --algorithm bayer |
+			ffmpeg -f rawvideo -pix_fmt rgba -s 3840x2160 -r 60 -i - out.mov
+
+	or with Y4M, which carries its own size:
+
+		ffmpeg -i in.mov -f yuv4mpegpipe - | punkdither-stream -f y4m | ffmpeg -i - out.mov
+
+	A reader thread, one or more worker threads and the writer (main thread)
+	share a fixed ring of frame slots, so reading, dithering and writing
+	overlap. Every buffer is allocated before the first frame; nothing is
+	allocated per frame. Workers take whole frames, so serial kernels like
+	error diffusion still scale across cores, and each worker's OpenMP team
+	gets its share of the remaining cores for the row-parallel kernels.
+*/
+
+#include "PunkDither_Kernels.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <omp.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+enum StreamFormat {
+	FORMAT_RGBA = 0,
+	FORMAT_RGB24,
+	FORMAT_Y4M
+};
+
+typedef struct StreamOptions {
+	StreamFormat format;
+	int width;
+	int height;
+	int direction;   // 1 = Up, 2 = Down, 3 = Left, 4 = Right
+	int workers;     // Frames in flight at once
+	int slots;       // Ring size (>= workers + 2)
+	bool animate;    // Pass the frame index to White Noise
+	bool perceptual; // Threshold on the OKLab colorA->colorB projection
+	PunkDitherParams dither;
+} StreamOptions;
+
+/* Y4M stream description (only the parts the converters need) */
+typedef struct Y4MInfo {
+	std::string header;  // Full header line, echoed to stdout
+	bool chroma420;      // C420* (otherwise 4:4:4)
+	bool fullRange;      // XCOLORRANGE=FULL
+} Y4MInfo;
+
+enum SlotState {
+	SLOT_FREE = 0,
+	SLOT_FILLED,
+	SLOT_WORKING,
+	SLOT_DONE
+};
+
+typedef struct FrameSlot {
+	std::vector<uint8_t> bytes; // One frame in the wire format
+	SlotState state;
+} FrameSlot;
+
+/* Per-worker memory: the ARGB buffer the kernels run on and their scratch */
+typedef struct WorkerState {
+	std::vector<PunkPixel8> pixels;
+	PunkDitherScratch scratch;
+	int ompThreads;
+} WorkerState;
+
+static std::mutex g_lock;
+static std::condition_variable g_changed;
+static std::vector<FrameSlot> g_slots;
+static long long g_nextToProcess = 0;
+static long long g_frameCount = -1;  // Set by the reader at end of input
+static bool g_failed = false;
+
+
+static void
+Usage()
+{
+	fprintf(stderr,
+		"usage: punkdither-stream [options] < input > output\n"
+		"  -f, --format rgba|rgb24|y4m   input/output format (default rgba)\n"
+		"  -s, --size WxH                frame size (required for rgba/rgb24)\n"
+		"  --algorithm NAME              diffusion|bayer|bluenoise|whitenoise (default diffusion)\n"
+		"  --direction NAME              up|down|left|right, for diffusion (default down)\n"
+		"  --strength N                  0..1 (default 0.5)\n"
+		"  --color-a RRGGBB              dark color (default 000000)\n"
+		"  --color-b RRGGBB              bright color (default FFFFFE)\n"
+		"  --color-mode luma|oklab       two-color level measure (default luma)\n"
+		"  --sharpen-amount N            0..4 pre-sharpen, 0 = off (default 0)\n"
+		"  --sharpen-radius N            1..64 (default 2)\n"
+		"  --seed N                      White Noise seed (default 0)\n"
+		"  --animate                     re-roll White Noise every frame\n"
+		"  --workers N                   frames processed at once (default: one per core\n"
+		"                                for diffusion, otherwise up to 4)\n"
+		"  --buffers N                   frame slots in the ring (default: workers + 2)\n");
+}
+
+static bool
+ParseColor(const char* text, PunkPixel8* color)
+{
+	if (text[0] == '#') text++;
+	if (strlen(text) != 6) return false;
+
+	char* end = NULL;
+	unsigned long value = strtoul(text, &end, 16);
+	if (*end) return false;
+
+	color->alpha = 255;
+	color->red = (uint8_t)(value >> 16);
+	color->green = (uint8_t)(value >> 8);
+	color->blue = (uint8_t)value;
+	return true;
+}
+
+static bool
+ParseOptions(int argc, char** argv, StreamOptions* opts)
+{
+	memset(opts, 0, sizeof(*opts));
+	opts->format = FORMAT_RGBA;
+	opts->direction = 2;
+	opts->dither.strength = 0.5;
+	opts->dither.colorA = { 255, 0, 0, 0 };
+	opts->dither.colorB = { 255, 255, 255, 254 };
+	opts->dither.algorithm = 1;
+	opts->dither.downscaleFactor = 1;
+	opts->dither.sharpenRadius = 2;
+	opts->dither.sharpenRadiusY = 2;
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+		bool takesValue = true;
+
+		if (arg == "-h" || arg == "--help") {
+			return false;
+		}
+		else if (arg == "--animate") {
+			opts->animate = true;
+			takesValue = false;
+		}
+		else if (!value) {
+			fprintf(stderr, "punkdither-stream: %s needs a value\n", arg.c_str());
+			return false;
+		}
+		else if (arg == "-f" || arg == "--format") {
+			std::string v = value;
+			if (v == "rgba") opts->format = FORMAT_RGBA;
+			else if (v == "rgb24") opts->format = FORMAT_RGB24;
+			else if (v == "y4m") opts->format = FORMAT_Y4M;
+			else { fprintf(stderr, "punkdither-stream: unknown format %s\n", value); return false; }
+		}
+		else if (arg == "-s" || arg == "--size") {
+			if (sscanf(value, "%dx%d", &opts->width, &opts->height) != 2) {
+				fprintf(stderr, "punkdither-stream: bad size %s\n", value);
+				return false;
+			}
+		}
+		else if (arg == "--algorithm") {
+			std::string v = value;
+			if (v == "diffusion") opts->dither.algorithm = 1;
+			else if (v == "bayer") opts->dither.algorithm = 2;
+			else if (v == "bluenoise") opts->dither.algorithm = 3;
+			else if (v == "whitenoise") opts->dither.algorithm = 4;
+			else { fprintf(stderr, "punkdither-stream: unknown algorithm %s\n", value); return false; }
+		}
+		else if (arg == "--direction") {
+			std::string v = value;
+			if (v == "up") opts->direction = 1;
+			else if (v == "down") opts->direction = 2;
+			else if (v == "left") opts->direction = 3;
+			else if (v == "right") opts->direction = 4;
+			else { fprintf(stderr, "punkdither-stream: unknown direction %s\n", value); return false; }
+		}
+		else if (arg == "--color-mode") {
+			std::string v = value;
+			if (v == "luma") opts->perceptual = false;
+			else if (v == "oklab") opts->perceptual = true;
+			else { fprintf(stderr, "punkdither-stream: unknown color mode %s\n", value); return false; }
+		}
+		else if (arg == "--strength") opts->dither.strength = std::min(1.0, std::max(0.0, atof(value)));
+		else if (arg == "--sharpen-amount") opts->dither.sharpenAmount = std::min(4.0, std::max(0.0, atof(value)));
+		else if (arg == "--sharpen-radius") {
+			opts->dither.sharpenRadius = std::min(64, std::max(1, atoi(value)));
+			opts->dither.sharpenRadiusY = opts->dither.sharpenRadius;
+		}
+		else if (arg == "--seed") opts->dither.noiseSeed = (uint32_t)strtoul(value, NULL, 10);
+		else if (arg == "--workers") opts->workers = atoi(value);
+		else if (arg == "--buffers") opts->slots = atoi(value);
+		else if (arg == "--color-a" || arg == "--color-b") {
+			if (!ParseColor(value, arg == "--color-a" ? &opts->dither.colorA : &opts->dither.colorB)) {
+				fprintf(stderr, "punkdither-stream: bad color %s\n", value);
+				return false;
+			}
+		}
+		else {
+			fprintf(stderr, "punkdither-stream: unknown option %s\n", arg.c_str());
+			return false;
+		}
+
+		if (takesValue) i++;
+	}
+
+	if (opts->format != FORMAT_Y4M && (opts->width <= 0 || opts->height <= 0)) {
+		fprintf(stderr, "punkdither-stream: -s WxH is required for %s\n",
+			opts->format == FORMAT_RGBA ? "rgba" : "rgb24");
+		return false;
+	}
+
+	// Error diffusion is serial within a frame, so only whole-frame workers
+	// speed it up; the other kernels split a frame across OpenMP threads.
+	int cores = (int)std::max(1u, std::thread::hardware_concurrency());
+	if (opts->workers <= 0) opts->workers = opts->dither.algorithm == 1 ? cores : std::min(4, cores);
+	opts->slots = std::max(opts->slots, opts->workers + 2);
+	return true;
+}
+
+/* Reads the Y4M stream header and fills in the frame size */
+static bool
+ReadY4MHeader(StreamOptions* opts, Y4MInfo* info)
+{
+	char line[1024];
+	if (!fgets(line, sizeof(line), stdin) || strncmp(line, "YUV4MPEG2 ", 10) != 0) {
+		fprintf(stderr, "punkdither-stream: input is not a YUV4MPEG2 stream\n");
+		return false;
+	}
+
+	info->header = line;
+	info->chroma420 = true;  // The Y4M default
+	info->fullRange = false;
+
+	for (char* tok = strtok(line + 10, " \n"); tok; tok = strtok(NULL, " \n")) {
+		switch (tok[0]) {
+		case 'W': opts->width = atoi(tok + 1); break;
+		case 'H': opts->height = atoi(tok + 1); break;
+		case 'C':
+			// 8-bit only: C420p10, C444p12 etc. must not slip through a prefix match
+			if (strcmp(tok + 1, "420") == 0 || strcmp(tok + 1, "420jpeg") == 0 ||
+				strcmp(tok + 1, "420paldv") == 0 || strcmp(tok + 1, "420mpeg2") == 0) {
+				info->chroma420 = true;
+			}
+			else if (strcmp(tok + 1, "444") == 0) info->chroma420 = false;
+			else {
+				fprintf(stderr, "punkdither-stream: unsupported Y4M colorspace %s (8-bit 420, 420jpeg, 420paldv, 420mpeg2 or 444 only)\n", tok + 1);
+				return false;
+			}
+			break;
+		case 'X':
+			if (strcmp(tok, "XCOLORRANGE=FULL") == 0) info->fullRange = true;
+			break;
+		}
+	}
+
+	if (opts->width <= 0 || opts->height <= 0) {
+		fprintf(stderr, "punkdither-stream: Y4M header has no frame size\n");
+		return false;
+	}
+	return true;
+}
+
+static size_t
+FrameBytes(const StreamOptions* opts, const Y4MInfo* y4m)
+{
+	size_t pixels = (size_t)opts->width * opts->height;
+
+	switch (opts->format) {
+	case FORMAT_RGBA:  return pixels * 4;
+	case FORMAT_RGB24: return pixels * 3;
+	case FORMAT_Y4M:
+		if (y4m->chroma420) {
+			size_t chroma = (size_t)((opts->width + 1) / 2) * ((opts->height + 1) / 2);
+			return pixels + 2 * chroma;
+		}
+		return pixels * 3;
+	}
+	return 0;
+}
+
+static bool
+ReadFully(uint8_t* dst, size_t bytes)
+{
+	size_t done = 0;
+	while (done < bytes) {
+		size_t n = fread(dst + done, 1, bytes - done, stdin);
+		if (n == 0) {
+			if (done) fprintf(stderr, "punkdither-stream: dropping truncated last frame\n");
+			return false;
+		}
+		done += n;
+	}
+	return true;
+}
+
+/* Consumes a Y4M "FRAME[ params]\n" line. Returns 1 when one was read, 0 at
+   a clean end of input and -1 when the stream is corrupt or misaligned. */
+static int
+ReadY4MFrameHeader()
+{
+	char tag[6];
+	size_t n = fread(tag, 1, 5, stdin);
+	if (n == 0) {
+		return 0;
+	}
+	if (n != 5 || memcmp(tag, "FRAME", 5) != 0) {
+		fprintf(stderr, "punkdither-stream: bad Y4M frame header\n");
+		return -1;
+	}
+	int c;
+	while ((c = fgetc(stdin)) != EOF && c != '\n') {}
+	if (c != '\n') {
+		fprintf(stderr, "punkdither-stream: truncated Y4M frame header\n");
+		return -1;
+	}
+	return 1;
+}
+
+static inline uint8_t
+Clamp8(int v)
+{
+	return (uint8_t)(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+/* BT.601 YCbCr <-> RGB in 8.8 fixed point */
+static inline void
+YuvToRgb(int y, int u, int v, bool fullRange, PunkPixel8* p)
+{
+	u -= 128;
+	v -= 128;
+	if (fullRange) {
+		p->red = Clamp8(y + ((359 * v + 128) >> 8));
+		p->green = Clamp8(y - ((88 * u + 183 * v - 128) >> 8));
+		p->blue = Clamp8(y + ((454 * u + 128) >> 8));
+	}
+	else {
+		int c = 298 * (y - 16) + 128;
+		p->red = Clamp8((c + 409 * v) >> 8);
+		p->green = Clamp8((c - 100 * u - 208 * v) >> 8);
+		p->blue = Clamp8((c + 516 * u) >> 8);
+	}
+	p->alpha = 255;
+}
+
+static inline void
+RgbToYuv(int r, int g, int b, bool fullRange, int* y, int* u, int* v)
+{
+	if (fullRange) {
+		*y = (77 * r + 150 * g + 29 * b + 128) >> 8;
+		*u = ((-43 * r - 85 * g + 128 * b + 128) >> 8) + 128;
+		*v = ((128 * r - 107 * g - 21 * b + 128) >> 8) + 128;
+	}
+	else {
+		*y = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+		*u = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+		*v = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+	}
+}
+
+static void
+UnpackFrame(const StreamOptions* opts, const Y4MInfo* y4m, const uint8_t* src, PunkPixel8* dst)
+{
+	int width = opts->width;
+	int height = opts->height;
+
+#pragma omp parallel for schedule(static)
+	for (int y = 0; y < height; y++) {
+		PunkPixel8* row = dst + (size_t)y * width;
+
+		if (opts->format == FORMAT_RGBA) {
+			const uint8_t* s = src + (size_t)y * width * 4;
+			for (int x = 0; x < width; x++, s += 4) {
+				row[x].red = s[0];
+				row[x].green = s[1];
+				row[x].blue = s[2];
+				row[x].alpha = s[3];
+			}
+		}
+		else if (opts->format == FORMAT_RGB24) {
+			const uint8_t* s = src + (size_t)y * width * 3;
+			for (int x = 0; x < width; x++, s += 3) {
+				row[x].red = s[0];
+				row[x].green = s[1];
+				row[x].blue = s[2];
+				row[x].alpha = 255;
+			}
+		}
+		else {
+			const uint8_t* lumaRow = src + (size_t)y * width;
+			if (y4m->chroma420) {
+				int cw = (width + 1) / 2;
+				const uint8_t* uRow = src + (size_t)width * height + (size_t)(y / 2) * cw;
+				const uint8_t* vRow = uRow + (size_t)cw * ((height + 1) / 2);
+				for (int x = 0; x < width; x++) {
+					YuvToRgb(lumaRow[x], uRow[x / 2], vRow[x / 2], y4m->fullRange, &row[x]);
+				}
+			}
+			else {
+				const uint8_t* uRow = lumaRow + (size_t)width * height;
+				const uint8_t* vRow = uRow + (size_t)width * height;
+				for (int x = 0; x < width; x++) {
+					YuvToRgb(lumaRow[x], uRow[x], vRow[x], y4m->fullRange, &row[x]);
+				}
+			}
+		}
+	}
+}
+
+static void
+PackFrame(const StreamOptions* opts, const Y4MInfo* y4m, const PunkPixel8* src, uint8_t* dst)
+{
+	int width = opts->width;
+	int height = opts->height;
+
+	if (opts->format == FORMAT_Y4M && y4m->chroma420) {
+		// Luma per pixel, chroma averaged over each 2x2 block
+		int cw = (width + 1) / 2;
+		int ch = (height + 1) / 2;
+		uint8_t* uPlane = dst + (size_t)width * height;
+		uint8_t* vPlane = uPlane + (size_t)cw * ch;
+
+#pragma omp parallel for schedule(static)
+		for (int cy = 0; cy < ch; cy++) {
+			for (int cx = 0; cx < cw; cx++) {
+				int uSum = 0, vSum = 0, n = 0;
+				for (int dy = 0; dy < 2; dy++) {
+					int y = cy * 2 + dy;
+					if (y >= height) break;
+					for (int dx = 0; dx < 2; dx++) {
+						int x = cx * 2 + dx;
+						if (x >= width) break;
+						const PunkPixel8* p = src + (size_t)y * width + x;
+						int yy, uu, vv;
+						RgbToYuv(p->red, p->green, p->blue, y4m->fullRange, &yy, &uu, &vv);
+						dst[(size_t)y * width + x] = Clamp8(yy);
+						uSum += uu;
+						vSum += vv;
+						n++;
+					}
+				}
+				uPlane[(size_t)cy * cw + cx] = Clamp8((uSum + n / 2) / n);
+				vPlane[(size_t)cy * cw + cx] = Clamp8((vSum + n / 2) / n);
+			}
+		}
+		return;
+	}
+
+#pragma omp parallel for schedule(static)
+	for (int y = 0; y < height; y++) {
+		const PunkPixel8* row = src + (size_t)y * width;
+
+		if (opts->format == FORMAT_RGBA) {
+			uint8_t* d = dst + (size_t)y * width * 4;
+			for (int x = 0; x < width; x++, d += 4) {
+				d[0] = row[x].red;
+				d[1] = row[x].green;
+				d[2] = row[x].blue;
+				d[3] = row[x].alpha;
+			}
+		}
+		else if (opts->format == FORMAT_RGB24) {
+			uint8_t* d = dst + (size_t)y * width * 3;
+			for (int x = 0; x < width; x++, d += 3) {
+				d[0] = row[x].red;
+				d[1] = row[x].green;
+				d[2] = row[x].blue;
+			}
+		}
+		else {
+			uint8_t* lumaRow = dst + (size_t)y * width;
+			uint8_t* uRow = lumaRow + (size_t)width * height;
+			uint8_t* vRow = uRow + (size_t)width * height;
+			for (int x = 0; x < width; x++) {
+				int yy, uu, vv;
+				RgbToYuv(row[x].red, row[x].green, row[x].blue, y4m->fullRange, &yy, &uu, &vv);
+				lumaRow[x] = Clamp8(yy);
+				uRow[x] = Clamp8(uu);
+				vRow[x] = Clamp8(vv);
+			}
+		}
+	}
+}
+
+static void
+ReaderThread(const StreamOptions* opts, size_t frameBytes)
+{
+	long long seq = 0;
+
+	for (;; seq++) {
+		FrameSlot& slot = g_slots[seq % g_slots.size()];
+		{
+			std::unique_lock<std::mutex> lock(g_lock);
+			g_changed.wait(lock, [&] { return slot.state == SLOT_FREE || g_failed; });
+			if (g_failed) break;
+		}
+
+		if (opts->format == FORMAT_Y4M) {
+			int header = ReadY4MFrameHeader();
+			if (header < 0) {
+				std::lock_guard<std::mutex> lock(g_lock);
+				g_failed = true;
+				g_changed.notify_all();
+			}
+			if (header <= 0) break;
+		}
+		if (!ReadFully(slot.bytes.data(), frameBytes)) break;
+
+		std::lock_guard<std::mutex> lock(g_lock);
+		slot.state = SLOT_FILLED;
+		g_changed.notify_all();
+	}
+
+	std::lock_guard<std::mutex> lock(g_lock);
+	g_frameCount = seq;
+	g_changed.notify_all();
+}
+
+static void
+WorkerThread(const StreamOptions* opts, const Y4MInfo* y4m, WorkerState* worker)
+{
+	omp_set_num_threads(worker->ompThreads);
+
+	PunkBuffer buffer;
+	buffer.data = worker->pixels.data();
+	buffer.width = opts->width;
+	buffer.height = opts->height;
+	buffer.rowbytes = opts->width * (int)sizeof(PunkPixel8);
+
+	for (;;) {
+		long long seq;
+		FrameSlot* slot;
+		{
+			std::unique_lock<std::mutex> lock(g_lock);
+			g_changed.wait(lock, [&] {
+				return g_failed ||
+					(g_frameCount >= 0 && g_nextToProcess >= g_frameCount) ||
+					g_slots[g_nextToProcess % g_slots.size()].state == SLOT_FILLED;
+			});
+			if (g_failed || (g_frameCount >= 0 && g_nextToProcess >= g_frameCount)) return;
+
+			seq = g_nextToProcess++;
+			slot = &g_slots[seq % g_slots.size()];
+			slot->state = SLOT_WORKING;
+		}
+
+		PunkDitherParams dither = opts->dither;
+		dither.noiseFrame = opts->animate ? (int32_t)seq : 0;
+
+		UnpackFrame(opts, y4m, slot->bytes.data(), worker->pixels.data());
+		RunPunkDither(&buffer, &dither, opts->direction, &worker->scratch);
+		PackFrame(opts, y4m, worker->pixels.data(), slot->bytes.data());
+
+		std::lock_guard<std::mutex> lock(g_lock);
+		slot->state = SLOT_DONE;
+		g_changed.notify_all();
+	}
+}
+
+int
+main(int argc, char** argv)
+{
+	StreamOptions opts;
+	if (!ParseOptions(argc, argv, &opts)) {
+		Usage();
+		return 2;
+	}
+
+#ifdef _WIN32
+	_setmode(_fileno(stdin), _O_BINARY);
+	_setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+	Y4MInfo y4m;
+	y4m.chroma420 = false;
+	y4m.fullRange = false;
+	if (opts.format == FORMAT_Y4M && !ReadY4MHeader(&opts, &y4m)) {
+		return 1;
+	}
+
+	size_t frameBytes = FrameBytes(&opts, &y4m);
+	size_t pixels = (size_t)opts.width * opts.height;
+
+	// Everything a frame needs is allocated here, up front.
+	std::vector<uint8_t> projection;
+	if (opts.perceptual) {
+		projection.resize(PUNK_PROJECTION_LUT_SIZE);
+		BuildProjectionLUT(projection.data(), opts.dither.colorA, opts.dither.colorB);
+		opts.dither.projectionLUT = projection.data();
+	}
+
+	g_slots.resize(opts.slots);
+	for (FrameSlot& slot : g_slots) {
+		slot.bytes.resize(frameBytes);
+		slot.state = SLOT_FREE;
+	}
+
+	int cores = (int)std::max(1u, std::thread::hardware_concurrency());
+	std::vector<WorkerState> workers(opts.workers);
+	for (WorkerState& worker : workers) {
+		worker.pixels.resize(pixels);
+		worker.ompThreads = std::max(1, cores / opts.workers);
+
+		// Size the kernel scratch once with a throwaway pass over a blank frame.
+		PunkBuffer warm = { worker.pixels.data(), opts.width, opts.height, opts.width * (int)sizeof(PunkPixel8) };
+		omp_set_num_threads(worker.ompThreads);
+		RunPunkDither(&warm, &opts.dither, opts.direction, &worker.scratch);
+	}
+
+	if (opts.format == FORMAT_Y4M) {
+		fputs(y4m.header.c_str(), stdout);
+	}
+
+	std::thread reader(ReaderThread, &opts, frameBytes);
+	std::vector<std::thread> workerThreads;
+	for (WorkerState& worker : workers) {
+		workerThreads.emplace_back(WorkerThread, &opts, &y4m, &worker);
+	}
+
+	// Writer: emit frames strictly in order, then hand the slot back to the reader.
+	int status = 0;
+	for (long long seq = 0;; seq++) {
+		FrameSlot& slot = g_slots[seq % g_slots.size()];
+		{
+			std::unique_lock<std::mutex> lock(g_lock);
+			g_changed.wait(lock, [&] {
+				return slot.state == SLOT_DONE || g_failed || (g_frameCount >= 0 && seq >= g_frameCount);
+			});
+			if (g_failed) {
+				status = 1;
+				break;
+			}
+			if (slot.state != SLOT_DONE) break;
+		}
+
+		bool ok = (opts.format != FORMAT_Y4M || fputs("FRAME\n", stdout) >= 0) &&
+			fwrite(slot.bytes.data(), 1, frameBytes, stdout) == frameBytes;
+
+		std::lock_guard<std::mutex> lock(g_lock);
+		if (!ok) {
+			fprintf(stderr, "punkdither-stream: write failed\n");
+			g_failed = true;
+			status = 1;
+			g_changed.notify_all();
+			break;
+		}
+		slot.state = SLOT_FREE;
+		g_changed.notify_all();
+	}
+
+	fflush(stdout);
+	reader.join();
+	for (std::thread& t : workerThreads) {
+		t.join();
+	}
+	return status;
+}